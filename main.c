@@ -4,6 +4,8 @@
 #include <string.h>
 #include <time.h>
 #include <stdarg.h> // obsługa zmiennej liczby argumentów
+#include <stdint.h> // generator losowy w trybie symulacji
+#include <limits.h> // INT_MAX przy ograniczaniu szerokości paczki
 
 // komendy do animacji ataku
 #ifdef _WIN32
@@ -14,16 +16,25 @@
 
 #define MAX_NAME   40 
 #define MAX_READY  10
+#define MAX_ROUNDS 1000 // limit rund w trybie symulacji, potem remis
+#define SIM_DEFAULT_BATTLES 10000
+#define SIM_DEFAULT_WIDTH   256 // ile bitew liczy naraz silnik paczkowy
+#define SIM_MAX_WIDTH       4096
+#define SIM_Z2_LIMIT   9.0   // |z| < 3
+#define SIM_CHI2_LIMIT 11.83 // chi-kwadrat, 2 stopnie swobody, ten sam poziom istotności co |z| < 3
 
 #define UNITS_FILE "units.txt" // plik z jednostkami
 #define LOG_FILE   "battle_log.txt" // logi
 #define SUMMARY_FILE "summary.txt" // podsumowanie bitwy
 
 static FILE* g_log = NULL; // log do komendy poniżej
+static bool g_quiet = false; // wycisza log i animacje (tryb symulacji)
 // komenda, która pozwala zapisywać tekst na żywo, a także do pliku
 #define LOGF(...) do {\
-    printf(__VA_ARGS__); \
-    if (g_log) fprintf(g_log, __VA_ARGS__); \
+    if (!g_quiet) { \
+        printf(__VA_ARGS__); \
+        if (g_log) fprintf(g_log, __VA_ARGS__); \
+    } \
 } while(0)
 
 
@@ -56,18 +67,98 @@ typedef struct { // lista, ilosc, morale, luck
     int luck;
 } Army;
 
+static bool g_fast_rng = false; // tryb symulacji: rand_range losuje z xorshift32 zamiast rand()
+static uint32_t g_rng_state = 1;
+
+static inline uint32_t xorshift32(uint32_t x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+static inline int scale_roll(uint32_t x, int min, int max) { // liczba z przedziału [min, max] z 32 losowych bitów, mnożenie zamiast dzielenia
+    return min + (int)(((uint64_t)x * (uint64_t)(max - min + 1)) >> 32);
+}
+
 static int rand_range(int min, int max) {
+    if (g_fast_rng) {
+        g_rng_state = xorshift32(g_rng_state);
+        return scale_roll(g_rng_state, min, max);
+    }
     return min + rand() % (max - min + 1);
 }
 
-static int generate_stack(int min_val, int max_val, int rank, int total_ranks) { // generator jednostek, dzięki niemu w słabszych jednostek jest więcej, silniejszych mniej.
+static void stack_bounds(int min_val, int max_val, int rank, int total_ranks, int* lower, int* upper) { // przedział liczebności stacku dla danej rangi
     int range = max_val - min_val + 1;
-    int upper = max_val - (rank - 1) * range / total_ranks;
-    int lower = min_val + (total_ranks - rank) * range / total_ranks;
-    if (lower > upper) lower = upper;
+    *upper = max_val - (rank - 1) * range / total_ranks;
+    *lower = min_val + (total_ranks - rank) * range / total_ranks;
+    if (*lower > *upper) *lower = *upper;
+}
+
+static int generate_stack(int min_val, int max_val, int rank, int total_ranks) { // generator jednostek, dzięki niemu w słabszych jednostek jest więcej, silniejszych mniej.
+    int lower, upper;
+    stack_bounds(min_val, max_val, rank, total_ranks, &lower, &upper);
     return rand_range(lower, upper);
 }
 
+// zasady walki wspólne dla gry i trybu symulacji
+static double strike_damage(int single, int stack, int defense, double per_def, double max_mod, double min_frac) { // obrażenia stacku przed szczęściem
+    double base_damage = (double)single * stack;
+
+    double defense_modifier = per_def * defense;
+    if (defense_modifier > max_mod) defense_modifier = max_mod;
+
+    double damage = base_damage * (1.0 - defense_modifier);
+    if (damage < base_damage * min_frac) damage = base_damage * min_frac;
+    if (damage < 1) damage = 1;
+    return damage;
+}
+
+static double attack_damage(int single, int stack, int defense) {
+    return strike_damage(single, stack, defense, 0.06, 0.7, 0.65);
+}
+
+static double counter_damage(int single, int stack, int defense) {
+    return strike_damage(single, stack, defense, 0.07, 0.55, 0.4);
+}
+
+static double luck_factor(int luck, int roll) { // +50% lub -50% obrażeń, gdy rzut 1-10 mieści się w 2 * |szczęście|
+    return ((luck > 0) & (roll <= luck * 2)) ? 1.5 : ((luck < 0) & (roll <= -luck * 2)) ? 0.5 : 1.0;
+}
+
+static int take_damage(double damage, int hp, int* stack, int* current_hp) { // zwraca liczbę zabitych, stack 0 oznacza zniszczony oddział
+    int kills = (int)(damage / hp);
+    if (kills > *stack) kills = *stack;
+
+    *stack -= kills;
+    if (*stack <= 0) {
+        *stack = 0;
+        *current_hp = 0;
+        return kills;
+    }
+    *current_hp = (int)(damage - (double)kills * hp);
+    if (*current_hp < 0) *current_hp = 0;
+    return kills;
+}
+
+static int morale_effect(int morale, int roll) { // 1 = dwa ruchy z rzędu, -1 = utrata tury, 0 = bez efektu
+    return ((morale > 0) & (roll <= morale)) ? 1 : ((morale < 0) & (roll <= -morale)) ? -1 : 0;
+}
+
+static int defense_bonus(int defense) { // +30% obrony, co najmniej 1
+    int bonus = defense * 30 / 100;
+    return bonus < 1 ? 1 : bonus;
+}
+
+static bool ai_wants_defense(int current_hp, int hp, bool defended) { // AI broni się raz, gdy ostatnia istota ma mniej niż połowę HP
+    return current_hp < hp / 2 && !defended;
+}
+
+static int target_priority(int power, int stack) { // AI atakuje cel o największym power * stack
+    return power * stack;
+}
+
 static void army_init(Army* a, int morale, int luck) { // ustawia armię w stanie początkowym (pusta lista, morale, szczęście)
 
     a->head = NULL;
@@ -78,8 +169,9 @@ static void army_init(Army* a, int morale, int luck) { // ustawia armię w stani
 
 static void army_push_back(Army* a, const Unit* u) { // dodaje nową jednostkę do armii
     UnitNode* n = (UnitNode*)malloc(sizeof(UnitNode));
-    if (!n) {
-        LOGF("Błąd: brak pamięci (malloc).\n");
+    if (!n) { // błąd krytyczny, wypisywany także przy g_quiet
+        fprintf(stderr, "Błąd: brak pamięci (malloc).\n");
+        if (g_log) fprintf(g_log, "Błąd: brak pamięci (malloc).\n");
         exit(1);
     }
     n->u = *u;
@@ -107,6 +199,24 @@ static void army_free(Army* a) { // zwalnia pamięć zajętą przez jednostki ar
     a->count = 0;
 }
 
+static void army_roll_from(Army* dst, const Army* proto) { // nowa armia z tych samych jednostek: losuje morale, szczęście i stacki
+    army_init(dst, rand_range(-5, 5), rand_range(-5, 5));
+    int rank = 0;
+    for (UnitNode* n = proto->head; n; n = n->next) {
+        Unit u = n->u;
+        rank++;
+        u.stack = generate_stack(1, 300, rank, 7);
+        army_push_back(dst, &u);
+    }
+}
+
+static void army_advance_readiness(Army* a, bool first_turn) { // początek rundy: gotowość rośnie o 1/10 inicjatywy
+    for (UnitNode* n = a->head; n; n = n->next) {
+        if (first_turn) n->u.readiness = n->u.initiative;
+        else if (n->u.alive) n->u.readiness += n->u.initiative / 10.0;
+    }
+}
+
 static bool all_dead(const Army* army) { // sprawdza, czy wszystkie jednostki w armii są martwe
     for (UnitNode* n = army->head; n; n = n->next)
         if (n->u.alive) return false;
@@ -118,7 +228,7 @@ static Unit* choose_enemy_target(Army* enemy) { // AI wybiera cel o największym
     Unit* target = NULL;
     for (UnitNode* n = enemy->head; n; n = n->next) {
         if (n->u.alive) {
-            int unit_power = n->u.power * n->u.stack;
+            int unit_power = target_priority(n->u.power, n->u.stack);
             if (unit_power > max_power) {
                 max_power = unit_power;
                 target = &n->u;
@@ -192,6 +302,8 @@ static void show_summary(const Army* army, const char* title) {
 }
 
 static void attack_animation(const char* attacker_name, const char* defender_name, bool counter) { // animacja ataku
+    if (g_quiet) return;
+
     if (counter) LOGF("Kontratak");
     else LOGF("Atak");
     fflush(stdout);
@@ -227,6 +339,17 @@ static void attack_animation(const char* attacker_name, const char* defender_nam
     LOGF("\n");
 }
 
+static double roll_luck(const char* name, int luck) { // rzut na szczęście w grze, z komunikatem
+    if (luck == 0) return 1.0;
+
+    double factor = luck_factor(luck, rand_range(1, 10));
+    if (factor > 1.0)
+        LOGF("%s korzysta z POZYTYWNEGO szczęścia! (+50%% obrażeń)\n", name);
+    else if (factor < 1.0)
+        LOGF("%s doświadcza NEGATYWNEGO szczęścia! (-50%% obrażeń)\n", name);
+    return factor;
+}
+
 static void attack_with_counter(Unit* attacker, Unit* defender, int attacker_luck, int defender_luck) { // atak jednostki z uwzględnieniem obrony, szczęścia i jednorazowego kontrataku
 
     if (!attacker || !defender) return;
@@ -235,42 +358,15 @@ static void attack_with_counter(Unit* attacker, Unit* defender, int attacker_luc
     attack_animation(attacker->name, defender->name, false);
 
     int single_unit_damage = rand_range(attacker->min_damage, attacker->max_damage);
-    double base_damage = (double)single_unit_damage * attacker->stack;
-
-    double defense_modifier = 0.06 * defender->defense;
-    if (defense_modifier > 0.7) defense_modifier = 0.7;
-
-    double damage = base_damage * (1.0 - defense_modifier);
-    if (damage < base_damage * 0.65) damage = base_damage * 0.65;
-    if (damage < 1) damage = 1;
-
-    if (attacker_luck != 0) {
-        int roll = rand_range(1, 10);
-        if (attacker_luck > 0 && roll <= attacker_luck * 2) {
-            damage *= 1.5;
-            LOGF("%s korzysta z POZYTYWNEGO szczęścia! (+50%% obrażeń)\n", attacker->name);
-        }
-        else if (attacker_luck < 0 && roll <= -attacker_luck * 2) {
-            damage *= 0.5;
-            LOGF("%s doświadcza NEGATYWNEGO szczęścia! (-50%% obrażeń)\n", attacker->name);
-        }
-    }
-
-    int kills = (int)(damage / defender->hp);
-    if (kills > defender->stack) kills = defender->stack;
+    double damage = attack_damage(single_unit_damage, attacker->stack, defender->defense);
+    damage *= roll_luck(attacker->name, attacker_luck);
 
-    defender->stack -= kills;
-    if (defender->stack <= 0) {
-        defender->stack = 0;
+    int kills = take_damage(damage, defender->hp, &defender->stack, &defender->current_hp);
+    if (defender->stack == 0) {
         defender->alive = false;
-        defender->current_hp = 0;
         LOGF("Zabija %d jednostek, Pozostało: 0, HP: 0\n\n", kills);
         return;
     }
-    else {
-        defender->current_hp = (int)(damage - (double)kills * defender->hp);
-        if (defender->current_hp < 0) defender->current_hp = 0;
-    }
 
     LOGF("Zabija %d jednostek, Pozostało: %d, HP: %d\n\n", kills, defender->stack, defender->current_hp);
 
@@ -279,40 +375,11 @@ static void attack_with_counter(Unit* attacker, Unit* defender, int attacker_luc
         attack_animation(defender->name, attacker->name, true);
 
         single_unit_damage = rand_range(defender->min_damage, defender->max_damage);
-        base_damage = (double)single_unit_damage * defender->stack;
-
-        defense_modifier = 0.07 * attacker->defense;
-        if (defense_modifier > 0.55) defense_modifier = 0.55;
+        damage = counter_damage(single_unit_damage, defender->stack, attacker->defense);
+        damage *= roll_luck(defender->name, defender_luck);
 
-        damage = base_damage * (1.0 - defense_modifier);
-        if (damage < base_damage * 0.4) damage = base_damage * 0.4;
-        if (damage < 1) damage = 1;
-
-        if (defender_luck != 0) {
-            int roll = rand_range(1, 10);
-            if (defender_luck > 0 && roll <= defender_luck * 2) {
-                damage *= 1.5;
-                LOGF("%s korzysta z POZYTYWNEGO szczęścia! (+50%% obrażeń)\n", defender->name);
-            }
-            else if (defender_luck < 0 && roll <= -defender_luck * 2) {
-                damage *= 0.5;
-                LOGF("%s doświadcza NEGATYWNEGO szczęścia! (-50%% obrażeń)\n", defender->name);
-            }
-        }
-
-        int counter_kills = (int)(damage / attacker->hp);
-        if (counter_kills > attacker->stack) counter_kills = attacker->stack;
-
-        attacker->stack -= counter_kills;
-        if (attacker->stack <= 0) {
-            attacker->stack = 0;
-            attacker->alive = false;
-            attacker->current_hp = 0;
-        }
-        else {
-            attacker->current_hp = (int)(damage - (double)counter_kills * attacker->hp);
-            if (attacker->current_hp < 0) attacker->current_hp = 0;
-        }
+        int counter_kills = take_damage(damage, attacker->hp, &attacker->stack, &attacker->current_hp);
+        if (attacker->stack == 0) attacker->alive = false;
 
         LOGF("Zabija %d jednostek, Pozostało: %d, HP: %d\n\n", counter_kills, attacker->stack, attacker->current_hp);
     }
@@ -329,25 +396,17 @@ static void show_actions(Unit* u) {
 static void player_turn(Unit* u, Army* enemy, int morale, int luck, bool* escape_flag) { // tura gracza
     if (!u->alive || u->readiness < MAX_READY) return;
 
-    int morale_roll = rand_range(1, 10);
-    bool skip_turn = false;
-    bool double_turn = false;
-
-    if (morale != 0) {
-        if (morale > 0 && morale_roll <= morale) {
-            double_turn = true;
-            LOGF("%s otrzymuje POZYTYWNE morale! (dwa ruchy z rzędu)\n", u->name);
-        }
-        else if (morale < 0 && morale_roll <= -morale) {
-            skip_turn = true;
-            u->readiness /= 2;
-            LOGF("%s otrzymuje NEGATYWNE morale! (traci turę, gotowość bojowa zmniejszona o 50%%)\n", u->name);
-        }
+    int effect = morale_effect(morale, rand_range(1, 10));
+    if (effect > 0) {
+        LOGF("%s otrzymuje POZYTYWNE morale! (dwa ruchy z rzędu)\n", u->name);
+    }
+    else if (effect < 0) {
+        u->readiness /= 2;
+        LOGF("%s otrzymuje NEGATYWNE morale! (traci turę, gotowość bojowa zmniejszona o 50%%)\n", u->name);
+        return;
     }
 
-    if (skip_turn) return;
-
-    int actions = double_turn ? 2 : 1;
+    int actions = effect > 0 ? 2 : 1;
     for (int a = 0; a < actions; a++) {
         int choice;
         while (1) {
@@ -370,8 +429,7 @@ static void player_turn(Unit* u, Army* enemy, int morale, int luck, bool* escape
             }
             else if (choice == 2) {
                 if (!u->defended) {
-                    int bonus = u->defense * 30 / 100;
-                    if (bonus < 1) bonus = 1;
+                    int bonus = defense_bonus(u->defense);
                     u->defense += bonus;
                     u->defended = true;
                     u->countered = false;
@@ -406,29 +464,20 @@ static void player_turn(Unit* u, Army* enemy, int morale, int luck, bool* escape
 static void enemy_turn(Unit* u, Army* player, int morale, int luck) { // tura ai
     if (!u->alive || u->readiness < MAX_READY) return;
 
-    int morale_roll = rand_range(1, 10);
-    bool skip_turn = false;
-    bool double_turn = false;
-
-    if (morale != 0) {
-        if (morale > 0 && morale_roll <= morale) {
-            double_turn = true;
-            LOGF("%s otrzymuje POZYTYWNE morale! (dwa ruchy z rzędu)\n", u->name);
-        }
-        else if (morale < 0 && morale_roll <= -morale) {
-            skip_turn = true;
-            u->readiness /= 2;
-            LOGF("%s otrzymuje NEGATYWNE morale! (traci turę, gotowość bojowa zmniejszona o 50%%)\n", u->name);
-        }
+    int effect = morale_effect(morale, rand_range(1, 10));
+    if (effect > 0) {
+        LOGF("%s otrzymuje POZYTYWNE morale! (dwa ruchy z rzędu)\n", u->name);
+    }
+    else if (effect < 0) {
+        u->readiness /= 2;
+        LOGF("%s otrzymuje NEGATYWNE morale! (traci turę, gotowość bojowa zmniejszona o 50%%)\n", u->name);
+        return;
     }
 
-    if (skip_turn) return;
-
-    int actions = double_turn ? 2 : 1;
+    int actions = effect > 0 ? 2 : 1;
     for (int a = 0; a < actions; a++) {
-        if (u->current_hp < u->hp / 2 && !u->defended) {
-            int bonus = u->defense * 30 / 100;
-            if (bonus < 1) bonus = 1;
+        if (ai_wants_defense(u->current_hp, u->hp, u->defended)) {
+            int bonus = defense_bonus(u->defense);
             u->defense += bonus;
             u->defended = true;
             u->countered = false;
@@ -463,17 +512,9 @@ static void battle(Army* player, Army* enemy) { // walka
             break;
         }
 
-        if (first_turn) {
-            for (UnitNode* n = player->head; n; n = n->next) n->u.readiness = n->u.initiative;
-            for (UnitNode* n = enemy->head; n; n = n->next) n->u.readiness = n->u.initiative;
-            first_turn = false;
-        }
-        else {
-            for (UnitNode* n = player->head; n; n = n->next)
-                if (n->u.alive) n->u.readiness += n->u.initiative / 10.0;
-            for (UnitNode* n = enemy->head; n; n = n->next)
-                if (n->u.alive) n->u.readiness += n->u.initiative / 10.0;
-        }
+        army_advance_readiness(player, first_turn);
+        army_advance_readiness(enemy, first_turn);
+        first_turn = false;
 
         for (UnitNode* n = player->head; n; n = n->next) {
             player_turn(&n->u, enemy, player->morale, player->luck, &escape);
@@ -491,6 +532,29 @@ static void battle(Army* player, Army* enemy) { // walka
     if (escape) exit(0);
 }
 
+static int battle_auto(Army* player, Army* enemy, int* rounds_out) { // walka AI kontra AI bez wejścia i animacji: 1 wygrana gracza, -1 porażka, 0 remis
+    int rounds = 0;
+    int result = 0;
+
+    while (true) {
+        if (all_dead(enemy)) { result = 1; break; }
+        if (all_dead(player)) { result = -1; break; }
+        if (rounds == MAX_ROUNDS) break;
+
+        army_advance_readiness(player, rounds == 0);
+        army_advance_readiness(enemy, rounds == 0);
+
+        for (UnitNode* n = player->head; n; n = n->next)
+            enemy_turn(&n->u, enemy, player->morale, player->luck);
+        for (UnitNode* n = enemy->head; n; n = n->next)
+            enemy_turn(&n->u, player, enemy->morale, enemy->luck);
+        rounds++;
+    }
+
+    if (rounds_out) *rounds_out = rounds;
+    return result;
+}
+
 static void write_default_units_file(void) { // tworzenie units.txt
     FILE* f = fopen(UNITS_FILE, "w");
     if (!f) return;
@@ -610,9 +674,440 @@ static void save_summary_to_file(const Army* player, const Army* enemy) {
     fclose(f);
 }
 
-int main(void) {
+// === Tryb symulacji: wiele bitew AI kontra AI ===
+// Silnik paczkowy trzyma stan bitew kolumnami (pole[slot * width + bitwa]) i przesuwa wszystkie bitwy
+// w paczce o jeden ruch jednostki naraz. Gotowość, morale i koniec rundy liczone są maskami dla całej
+// paczki; do ataku trafiają tylko bitwy, w których jednostka ma ruch (ich indeksy są najpierw zbierane
+// w listę), bo gotowość rośnie o 0,8-1,6 na rundę, a ruch kosztuje 10, więc jednostka rusza się zwykle
+// raz na 6-12 rund. Bitwa zakończona wypada z maski active, a jej miejsce zajmuje od razu następna.
+
+typedef struct { // wyniki jednej ścieżki symulacji
+    int battles;
+    int wins;
+    int losses;
+    int draws;
+    long long rounds;
+    long long rounds_sq; // suma kwadratów, do wariancji liczby rund
+    double seconds;
+} SimStats;
+
+static void sim_tally(SimStats* st, int result, int rounds) {
+    st->battles++;
+    if (result > 0) st->wins++;
+    else if (result < 0) st->losses++;
+    else st->draws++;
+    st->rounds += rounds;
+    st->rounds_sq += (long long)rounds * rounds;
+}
+
+typedef struct { // paczka niezależnych bitew liczonych krok w krok
+    int width;          // liczba miejsc na bitwy (odstęp między kolumnami)
+    int span;           // pętle idą do span, dalej są już tylko zakończone bitwy
+    int player_slots;   // sloty 0..player_slots-1 to gracz, dalej wróg
+    int slots;
+    Unit* proto;        // statystyki bazowe slotów, wspólne dla całej paczki
+    int* stack;
+    int* current_hp;
+    int* defense;
+    double* readiness;
+    int* alive;
+    int* countered;
+    int* defended;
+    int* morale;        // [strona * width + bitwa], 0 = gracz, 1 = wróg
+    int* luck;
+    uint32_t* rng;      // osobny generator dla każdej bitwy
+    int* active;
+    int* rounds;
+    int* actions;       // bufory robocze jednego ruchu
+    int* lanes;
+    int* player_alive;
+    int* enemy_alive;
+} BattleBatch;
+
+static void* batch_alloc(size_t count, size_t size) {
+    void* p = calloc(count, size);
+    if (!p) {
+        fprintf(stderr, "Błąd: brak pamięci (calloc).\n");
+        exit(1);
+    }
+    return p;
+}
+
+static inline int lane_roll(uint32_t* state, int min, int max) { // odpowiednik rand_range na generatorze bitwy
+    uint32_t x = xorshift32(*state);
+    *state = x;
+    return scale_roll(x, min, max);
+}
+
+static void batch_init(BattleBatch* bb, const Army* player, const Army* enemy, int width) {
+    memset(bb, 0, sizeof(*bb));
+    bb->width = width;
+    bb->player_slots = player->count;
+    bb->slots = player->count + enemy->count;
+
+    bb->proto = (Unit*)batch_alloc(bb->slots, sizeof(Unit));
+    int s = 0;
+    for (UnitNode* n = player->head; n; n = n->next) bb->proto[s++] = n->u;
+    for (UnitNode* n = enemy->head; n; n = n->next) bb->proto[s++] = n->u;
+
+    size_t cells = (size_t)bb->slots * width;
+    bb->stack = (int*)batch_alloc(cells, sizeof(int));
+    bb->current_hp = (int*)batch_alloc(cells, sizeof(int));
+    bb->defense = (int*)batch_alloc(cells, sizeof(int));
+    bb->readiness = (double*)batch_alloc(cells, sizeof(double));
+    bb->alive = (int*)batch_alloc(cells, sizeof(int));
+    bb->countered = (int*)batch_alloc(cells, sizeof(int));
+    bb->defended = (int*)batch_alloc(cells, sizeof(int));
+    bb->morale = (int*)batch_alloc(2 * (size_t)width, sizeof(int));
+    bb->luck = (int*)batch_alloc(2 * (size_t)width, sizeof(int));
+    bb->rng = (uint32_t*)batch_alloc(width, sizeof(uint32_t));
+    bb->active = (int*)batch_alloc(width, sizeof(int));
+    bb->rounds = (int*)batch_alloc(width, sizeof(int));
+    bb->actions = (int*)batch_alloc(width, sizeof(int));
+    bb->lanes = (int*)batch_alloc(width, sizeof(int));
+    bb->player_alive = (int*)batch_alloc(width, sizeof(int));
+    bb->enemy_alive = (int*)batch_alloc(width, sizeof(int));
+
+    for (int b = 0; b < width; b++) {
+        uint32_t seed = ((uint32_t)rand() << 16) ^ (uint32_t)rand() ^ ((uint32_t)b * 0x9E3779B9u);
+        bb->rng[b] = seed ? seed : 1;
+    }
+}
+
+static void batch_free(BattleBatch* bb) {
+    free(bb->proto);
+    free(bb->stack);
+    free(bb->current_hp);
+    free(bb->defense);
+    free(bb->readiness);
+    free(bb->alive);
+    free(bb->countered);
+    free(bb->defended);
+    free(bb->morale);
+    free(bb->luck);
+    free(bb->rng);
+    free(bb->active);
+    free(bb->rounds);
+    free(bb->actions);
+    free(bb->lanes);
+    free(bb->player_alive);
+    free(bb->enemy_alive);
+    memset(bb, 0, sizeof(*bb));
+}
+
+static void batch_fill_lane(BattleBatch* bb, int b) { // nowa bitwa na miejscu b: morale, szczęście i stacki jak w army_roll_from, gotowość jak w pierwszej turze
+    const int w = bb->width;
+    uint32_t* rng = &bb->rng[b];
+
+    bb->morale[b] = lane_roll(rng, -5, 5);
+    bb->luck[b] = lane_roll(rng, -5, 5);
+    bb->morale[w + b] = lane_roll(rng, -5, 5);
+    bb->luck[w + b] = lane_roll(rng, -5, 5);
+
+    for (int s = 0; s < bb->slots; s++) {
+        const Unit* u = &bb->proto[s];
+        int rank = s < bb->player_slots ? s + 1 : s - bb->player_slots + 1;
+        int lower, upper;
+        stack_bounds(1, 300, rank, 7, &lower, &upper);
+
+        bb->stack[s * w + b] = lane_roll(rng, lower, upper);
+        bb->current_hp[s * w + b] = u->hp;
+        bb->defense[s * w + b] = u->defense;
+        bb->readiness[s * w + b] = u->initiative;
+        bb->alive[s * w + b] = 1;
+        bb->countered[s * w + b] = 0;
+        bb->defended[s * w + b] = 0;
+    }
+
+    bb->active[b] = 1;
+    bb->rounds[b] = 0;
+}
+
+static void batch_strike(BattleBatch* bb, int s, int t, int b, int side) { // atak slotu s na slot t w bitwie b z jednorazowym kontratakiem, zasady jak w attack_with_counter
+    const int w = bb->width;
+    const Unit* ua = &bb->proto[s];
+    const Unit* ud = &bb->proto[t];
+    uint32_t* rng = &bb->rng[b];
+    const int as = s * w + b;
+    const int ds = t * w + b;
+
+    double damage = attack_damage(lane_roll(rng, ua->min_damage, ua->max_damage), bb->stack[as], bb->defense[ds]);
+    damage *= luck_factor(bb->luck[side * w + b], lane_roll(rng, 1, 10));
+    take_damage(damage, ud->hp, &bb->stack[ds], &bb->current_hp[ds]);
+    if (bb->stack[ds] == 0) {
+        bb->alive[ds] = 0;
+        return;
+    }
+
+    if (bb->countered[ds]) return;
+    bb->countered[ds] = 1;
+
+    damage = counter_damage(lane_roll(rng, ud->min_damage, ud->max_damage), bb->stack[ds], bb->defense[as]);
+    damage *= luck_factor(bb->luck[(1 - side) * w + b], lane_roll(rng, 1, 10));
+    take_damage(damage, ua->hp, &bb->stack[as], &bb->current_hp[as]);
+    if (bb->stack[as] == 0) bb->alive[as] = 0;
+}
+
+static void batch_action(BattleBatch* bb, int s, int a, int count) { // a-ta akcja slotu s w bitwach z listy lanes: obrona albo atak na cel wybrany jak w choose_enemy_target
+    const int w = bb->width;
+    const int side = s < bb->player_slots ? 0 : 1;
+    const int t_begin = side == 0 ? bb->player_slots : 0;
+    const int t_end = side == 0 ? bb->slots : bb->player_slots;
+    const Unit* u = &bb->proto[s];
+
+    for (int i = 0; i < count; i++) {
+        const int b = bb->lanes[i];
+        const int cell = s * w + b;
+        if (bb->actions[b] <= a || !bb->alive[cell]) continue;
+
+        double r = bb->readiness[cell] - 10;
+        bb->readiness[cell] = r < 0 ? 0 : r;
+        bb->countered[cell] = 0;
+
+        if (ai_wants_defense(bb->current_hp[cell], u->hp, bb->defended[cell])) {
+            bb->defense[cell] += defense_bonus(bb->defense[cell]);
+            bb->defended[cell] = 1;
+            continue;
+        }
+
+        int target = -1, best = -1;
+        for (int t = t_begin; t < t_end; t++) {
+            int p = bb->alive[t * w + b] ? target_priority(bb->proto[t].power, bb->stack[t * w + b]) : -1;
+            if (p > best) {
+                best = p;
+                target = t;
+            }
+        }
+        if (target >= 0) batch_strike(bb, s, target, b, side);
+    }
+}
+
+static void batch_turn(BattleBatch* bb, int s) { // ruch slotu s we wszystkich bitwach naraz, logika jak w enemy_turn
+    const int w = bb->width, n = bb->span;
+    const int side = s < bb->player_slots ? 0 : 1;
+    const int* morale = bb->morale + side * w;
+    const int* alive_s = bb->alive + s * w;
+    double* readiness_s = bb->readiness + s * w;
+
+    for (int b = 0; b < n; b++) {
+        uint32_t x = xorshift32(bb->rng[b]);
+        bb->rng[b] = x;
+        int roll = scale_roll(x, 1, 10);
+        int ready = bb->active[b] & alive_s[b] & (readiness_s[b] >= MAX_READY);
+        int effect = morale_effect(morale[b], roll);
+        int double_turn = effect > 0;
+        int skip_turn = effect < 0;
+        readiness_s[b] = (ready & skip_turn) ? readiness_s[b] / 2 : readiness_s[b];
+        bb->actions[b] = (ready & !skip_turn) ? 1 + double_turn : 0;
+    }
+
+    // lista bitew, w których jednostka ma ruch (bez rozgałęzień)
+    int count = 0;
+    for (int b = 0; b < n; b++) {
+        bb->lanes[count] = b;
+        count += bb->actions[b] > 0;
+    }
+
+    batch_action(bb, s, 0, count);
+    batch_action(bb, s, 1, count);
+}
+
+static void batch_run(BattleBatch* bb, int battles, SimStats* st) { // liczy battles bitew, zakończone od razu zastępuje nowymi
+    const int w = bb->width;
+    int started = battles < w ? battles : w;
+
+    for (int b = 0; b < started; b++) batch_fill_lane(bb, b);
+    for (int b = started; b < w; b++) bb->active[b] = 0;
+    bb->span = started;
+
+    while (bb->span > 0) {
+        const int n = bb->span;
+
+        for (int s = 0; s < bb->slots; s++) {
+            const double step = bb->proto[s].initiative / 10.0;
+            const int* alive_s = bb->alive + s * w;
+            double* readiness_s = bb->readiness + s * w;
+            for (int b = 0; b < n; b++)
+                readiness_s[b] += (bb->active[b] & alive_s[b] & (bb->rounds[b] > 0)) ? step : 0.0;
+        }
+
+        for (int s = 0; s < bb->slots; s++)
+            batch_turn(bb, s);
+
+        // koniec rundy
+        for (int b = 0; b < n; b++) {
+            bb->player_alive[b] = 0;
+            bb->enemy_alive[b] = 0;
+        }
+        for (int s = 0; s < bb->slots; s++) {
+            int* side_alive = s < bb->player_slots ? bb->player_alive : bb->enemy_alive;
+            const int* alive_s = bb->alive + s * w;
+            for (int b = 0; b < n; b++)
+                side_alive[b] |= alive_s[b];
+        }
+        for (int b = 0; b < n; b++) {
+            if (!bb->active[b]) continue;
+            bb->rounds[b]++;
+            if (bb->player_alive[b] && bb->enemy_alive[b] && bb->rounds[b] < MAX_ROUNDS) continue;
+
+            sim_tally(st, !bb->enemy_alive[b] ? 1 : !bb->player_alive[b] ? -1 : 0, bb->rounds[b]);
+            if (started < battles) {
+                batch_fill_lane(bb, b);
+                started++;
+            }
+            else {
+                bb->active[b] = 0;
+            }
+        }
+
+        while (bb->span > 0 && !bb->active[bb->span - 1]) bb->span--;
+    }
+}
+
+static void sim_report(const SimStats* st, const char* title) {
+    double n = st->battles;
+    LOGF("%s: %d bitew w %.3f s (%.0f bitew/s)\n", title, st->battles, st->seconds,
+        st->seconds > 0 ? n / st->seconds : 0.0);
+    LOGF("   wygrane: %.2f%% | porażki: %.2f%% | remisy: %.2f%% | średnio rund: %.2f\n",
+        100.0 * st->wins / n, 100.0 * st->losses / n, 100.0 * st->draws / n, st->rounds / n);
+}
+
+static double sim_rounds_variance(const SimStats* st) { // wariancja z próby liczby rund
+    if (st->battles < 2) return 0.0;
+    double n = st->battles;
+    double mean = st->rounds / n;
+    return ((double)st->rounds_sq - n * mean * mean) / (n - 1);
+}
+
+static void sim_compare(const SimStats* a, const SimStats* b) { // testy zgodności obu ścieżek; progi porównywane z kwadratem statystyki, więc bez sqrt
+    if (a->battles < 2 || b->battles < 2) {
+        LOGF("Za mało bitew na porównanie wyników.\n");
+        return;
+    }
+    LOGF("Porównanie (próg: |z| < 3):\n");
+
+    // wygrane/porażki/remisy: chi-kwadrat dla tabeli 2x3
+    const int observed[2][3] = {
+        { a->wins, a->losses, a->draws },
+        { b->wins, b->losses, b->draws },
+    };
+    const double rows[2] = { a->battles, b->battles };
+    const double total = rows[0] + rows[1];
+    double chi2 = 0.0;
+    for (int j = 0; j < 3; j++) {
+        double column = observed[0][j] + observed[1][j];
+        if (column == 0) continue;
+        for (int i = 0; i < 2; i++) {
+            double expected = rows[i] * column / total;
+            double diff = observed[i][j] - expected;
+            chi2 += diff * diff / expected;
+        }
+    }
+    LOGF("   wygrane/porażki/remisy: chi^2 = %.2f (2 st. swobody, próg %.2f) -> %s\n", chi2, SIM_CHI2_LIMIT,
+        chi2 < SIM_CHI2_LIMIT ? "brak wykrytej różnicy" : "WYKRYTO RÓŻNICĘ");
+
+    // odsetek wygranych: z^2 = różnica^2 / wariancja różnicy
+    double p1 = (double)a->wins / a->battles;
+    double p2 = (double)b->wins / b->battles;
+    double pooled = (a->wins + b->wins) / total;
+    double win_var = pooled * (1.0 - pooled) * (1.0 / a->battles + 1.0 / b->battles);
+    double win_diff = p1 - p2;
+    LOGF("   wygrane: różnica %.3f pp, wariancja różnicy %.3g -> %s\n", 100.0 * win_diff, win_var,
+        win_diff * win_diff <= SIM_Z2_LIMIT * win_var ? "brak wykrytej różnicy" : "WYKRYTO RÓŻNICĘ");
+
+    // średnia liczba rund: test z dla dwóch prób
+    double rounds_var = sim_rounds_variance(a) / a->battles + sim_rounds_variance(b) / b->battles;
+    double rounds_diff = (double)a->rounds / a->battles - (double)b->rounds / b->battles;
+    LOGF("   średnio rund: różnica %.3f, wariancja różnicy %.3g -> %s\n", rounds_diff, rounds_var,
+        rounds_diff * rounds_diff <= SIM_Z2_LIMIT * rounds_var ? "brak wykrytej różnicy" : "WYKRYTO RÓŻNICĘ");
+}
+
+static void sim_run_single(const Army* player, const Army* enemy, int battles, SimStats* st) { // bitwa po bitwie, przez listy jednostek jak w zwykłej grze
+    clock_t start = clock();
+    for (int i = 0; i < battles; i++) {
+        Army p, e;
+        army_roll_from(&p, player);
+        army_roll_from(&e, enemy);
+        int rounds = 0;
+        int result = battle_auto(&p, &e, &rounds);
+        sim_tally(st, result, rounds);
+        army_free(&p);
+        army_free(&e);
+    }
+    st->seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void simulate(const Army* player, const Army* enemy, int battles, int width) { // porównanie: bitwa po bitwie (rand i xorshift32) vs paczka width bitew naraz
+    SimStats scalar = { 0 };
+    SimStats scalar_fast = { 0 };
+    SimStats batched = { 0 };
+
+    g_quiet = true;
+    sim_run_single(player, enemy, battles, &scalar);
+
+    // ten sam generator co w paczkach, żeby oddzielić zysk z generatora od zysku z układu kolumnowego
+    g_fast_rng = true;
+    g_rng_state = (((uint32_t)rand() << 16) ^ (uint32_t)rand()) | 1u;
+    sim_run_single(player, enemy, battles, &scalar_fast);
+    g_fast_rng = false;
+
+    BattleBatch bb;
+    batch_init(&bb, player, enemy, width);
+    clock_t start = clock();
+    batch_run(&bb, battles, &batched);
+    batched.seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    batch_free(&bb);
+    g_quiet = false;
+
+    LOGF("=== SYMULACJA AI KONTRA AI ===\n");
+    sim_report(&scalar, "Bitwa po bitwie (rand)");
+    sim_report(&scalar_fast, "Bitwa po bitwie (xorshift32)");
+    sim_report(&batched, "Paczkami (xorshift32)");
+    if (batched.seconds > 0 && scalar_fast.seconds > 0) {
+        LOGF("Przyspieszenie paczek (szerokość %d): %.2fx względem rand(), z tego generator %.2fx, układ kolumnowy %.2fx\n",
+            width, scalar.seconds / batched.seconds, scalar.seconds / scalar_fast.seconds,
+            scalar_fast.seconds / batched.seconds);
+    }
+
+    sim_compare(&scalar, &batched);
+}
+
+static int run_simulation(int argc, char** argv) { // gra --symulacja [liczba_bitew] [szerokość_paczki]
+    int battles = argc > 2 ? atoi(argv[2]) : SIM_DEFAULT_BATTLES;
+    int width = argc > 3 ? atoi(argv[3]) : SIM_DEFAULT_WIDTH;
+    if (battles < 1 || width < 1) {
+        LOGF("Użycie: %s --symulacja [liczba_bitew] [szerokość_paczki]\n", argv[0]);
+        return 1;
+    }
+
+    Army player, enemy;
+    army_init(&player, 0, 0);
+    army_init(&enemy, 0, 0);
+    if (!load_armies_from_file(&player, &enemy)) {
+        army_free(&player);
+        army_free(&enemy);
+        return 1;
+    }
+
+    // nie więcej miejsc niż bitew, a indeksy slot * width + bitwa muszą zmieścić się w int
+    int slots = player.count + enemy.count;
+    if (width > battles) width = battles;
+    if (width > SIM_MAX_WIDTH) width = SIM_MAX_WIDTH;
+    if (width > INT_MAX / slots) width = INT_MAX / slots;
+
+    simulate(&player, &enemy, battles, width);
+
+    army_free(&player);
+    army_free(&enemy);
+    return 0;
+}
+
+int main(int argc, char** argv) {
     srand((unsigned)time(NULL));
 
+    if (argc > 1 && strcmp(argv[1], "--symulacja") == 0)
+        return run_simulation(argc, argv);
+
     g_log = fopen(LOG_FILE, "w"); 
     if (!g_log) {
         printf("Uwaga: nie mogę utworzyć %s (log będzie tylko na ekranie).\n", LOG_FILE);